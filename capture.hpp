@@ -0,0 +1,173 @@
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+
+// Traffic capture file format (all integers big-endian, like send_frame):
+//
+//   header:  8 bytes magic "CHATCAP1"
+//   record:  u64 ts_us | u32 conn_id | u8 kind | u32 len | payload[len]
+//
+// ts_us is microseconds on a monotonic clock since the capture was opened.
+// The trailing len + payload is the same length-prefixed framing the server
+// uses on the wire, so a FRAME payload can be resent verbatim with send_frame.
+
+static const char CAPTURE_MAGIC[8] = { 'C', 'H', 'A', 'T', 'C', 'A', 'P', '1' };
+static const uint32_t CAPTURE_MAX_PAYLOAD = 10 * 1024 * 1024;
+
+enum class CaptureKind : uint8_t {
+    CONNECT = 0,    // payload is the username line sent on connect
+    FRAME = 1,      // payload is one inbound frame
+    DISCONNECT = 2  // payload is empty
+};
+
+struct CaptureRecord {
+    uint64_t ts_us;
+    uint32_t conn_id;
+    CaptureKind kind;
+    std::string payload;
+
+    CaptureRecord() : ts_us(0), conn_id(0), kind(CaptureKind::FRAME) {}
+};
+
+class CaptureWriter {
+private:
+    std::ofstream out_;
+    std::chrono::steady_clock::time_point start_;
+    bool dirty_;
+
+    void put_u32(uint32_t v) {
+        char b[4] = {
+            static_cast<char>(v >> 24), static_cast<char>(v >> 16),
+            static_cast<char>(v >> 8), static_cast<char>(v)
+        };
+        out_.write(b, 4);
+    }
+
+    void put_u64(uint64_t v) {
+        put_u32(static_cast<uint32_t>(v >> 32));
+        put_u32(static_cast<uint32_t>(v));
+    }
+
+public:
+    CaptureWriter() : dirty_(false) {}
+
+    ~CaptureWriter() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        out_.open(path, std::ios::binary | std::ios::trunc);
+        if (!out_) return false;
+        out_.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+        start_ = std::chrono::steady_clock::now();
+        dirty_ = true;
+        return static_cast<bool>(out_);
+    }
+
+    bool is_open() const {
+        return out_.is_open();
+    }
+
+    void record(uint32_t conn_id, CaptureKind kind, const std::string& payload = std::string()) {
+        if (!out_.is_open()) return;
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        put_u64(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        put_u32(conn_id);
+        char k = static_cast<char>(kind);
+        out_.write(&k, 1);
+        put_u32(static_cast<uint32_t>(payload.size()));
+        out_.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        dirty_ = true;
+    }
+
+    // Records are buffered; the server calls this once per select() pass so a
+    // burst costs one write, and at most one pass is lost if the process dies.
+    // Returns false once if a write failed (e.g. disk full); the writer is then
+    // closed and further records are dropped.
+    bool flush() {
+        if (dirty_ && out_.is_open()) {
+            out_.flush();
+            dirty_ = false;
+            if (!out_) {
+                out_.close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool close() {
+        bool ok = true;
+        if (out_.is_open()) {
+            ok = flush();
+            if (out_.is_open()) out_.close();
+        }
+        return ok;
+    }
+};
+
+class CaptureReader {
+private:
+    std::ifstream in_;
+    bool failed_;
+
+    bool get_u32(uint32_t& v) {
+        unsigned char b[4];
+        if (!in_.read(reinterpret_cast<char*>(b), 4)) return false;
+        v = (static_cast<uint32_t>(b[0]) << 24) | (static_cast<uint32_t>(b[1]) << 16) |
+            (static_cast<uint32_t>(b[2]) << 8) | static_cast<uint32_t>(b[3]);
+        return true;
+    }
+
+    bool get_u64(uint64_t& v) {
+        uint32_t hi = 0, lo = 0;
+        if (!get_u32(hi) || !get_u32(lo)) return false;
+        v = (static_cast<uint64_t>(hi) << 32) | lo;
+        return true;
+    }
+
+public:
+    CaptureReader() : failed_(false) {}
+
+    bool open(const std::string& path) {
+        in_.open(path, std::ios::binary);
+        if (!in_) return false;
+        char magic[sizeof(CAPTURE_MAGIC)];
+        if (!in_.read(magic, sizeof(magic))) return false;
+        return std::string(magic, sizeof(magic)) ==
+               std::string(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    }
+
+    // Returns false at end of file or on a truncated/corrupt record; failed()
+    // tells the two apart.
+    bool next(CaptureRecord& rec) {
+        if (in_.peek() == std::char_traits<char>::eof()) return false;
+        failed_ = true;
+        uint64_t ts = 0;
+        uint32_t id = 0, len = 0;
+        char k = 0;
+        if (!get_u64(ts) || !get_u32(id)) return false;
+        if (!in_.read(&k, 1)) return false;
+        if (static_cast<uint8_t>(k) > static_cast<uint8_t>(CaptureKind::DISCONNECT)) return false;
+        if (!get_u32(len)) return false;
+        if (len > CAPTURE_MAX_PAYLOAD) return false;
+        rec.ts_us = ts;
+        rec.conn_id = id;
+        rec.kind = static_cast<CaptureKind>(k);
+        rec.payload.resize(len);
+        if (len > 0 && !in_.read(&rec.payload[0], len)) return false;
+        failed_ = false;
+        return true;
+    }
+
+    bool failed() const {
+        return failed_;
+    }
+};
+
+#endif
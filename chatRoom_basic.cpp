@@ -4,6 +4,7 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <ctime>
+#include "capture.hpp"
 
 #pragma comment(lib, "ws2_32.lib")
 
@@ -112,17 +113,29 @@ private:
     SOCKET server_socket;
     std::vector<SOCKET> clients;
     std::vector<std::string> usernames;
+    std::vector<uint32_t> conn_ids;
+    uint32_t next_conn_id;
     std::string room_name;
     bool running;
+    CaptureWriter capture;
     
 public:
     BasicChatRoom(const std::string& name = "Basic Chat Room") 
-        : server_socket(INVALID_SOCKET), room_name(name), running(false) {}
+        : server_socket(INVALID_SOCKET), next_conn_id(1), room_name(name), running(false) {}
     
     ~BasicChatRoom() {
         stop();
     }
     
+    bool enable_capture(const std::string& path) {
+        if (!capture.open(path)) {
+            log_err("Failed to open capture file: " + path);
+            return false;
+        }
+        log_info("Capturing inbound traffic to " + path);
+        return true;
+    }
+    
     bool start(int port) {
         WSADATA wsaData;
         if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
@@ -171,6 +184,10 @@ public:
         }
         clients.clear();
         usernames.clear();
+        conn_ids.clear();
+        if (!capture.close()) {
+            log_err("Capture write failed; capture file is incomplete");
+        }
         
         if (server_socket != INVALID_SOCKET) {
             closesocket(server_socket);
@@ -218,6 +235,10 @@ public:
                     }
                 }
             }
+            
+            if (!capture.flush()) {
+                log_err("Capture write failed; capture stopped");
+            }
         }
     }
     
@@ -237,8 +258,12 @@ private:
                 username = "Anonymous_" + std::to_string(rand() % 1000);
             }
             
+            uint32_t conn_id = next_conn_id++;
+            capture.record(conn_id, CaptureKind::CONNECT, username);
+            
             clients.push_back(client_socket);
             usernames.push_back(username);
+            conn_ids.push_back(conn_id);
             
             std::string join_json = make_chat_json("JOIN", username, username + " joined the chat");
             broadcast_json(join_json, client_socket);
@@ -265,6 +290,7 @@ private:
         if (!recv_frame(client_socket, frame)) {
             return false;
         }
+        capture.record(conn_ids[client_index], CaptureKind::FRAME, frame);
         
         const std::string& username = usernames[client_index];
         std::string type = json_get_string(frame, "type");
@@ -293,12 +319,14 @@ private:
     void remove_client(size_t index) {
         std::string username = usernames[index];
         SOCKET client_socket = clients[index];
+        capture.record(conn_ids[index], CaptureKind::DISCONNECT);
         
         std::string leave_json = make_chat_json("LEAVE", username, username + " left the chat");
         broadcast_json(leave_json);
         
         clients.erase(clients.begin() + index);
         usernames.erase(usernames.begin() + index);
+        conn_ids.erase(conn_ids.begin() + index);
         closesocket(client_socket);
         
         log_info("Client disconnected: " + username);
@@ -308,6 +336,7 @@ private:
 int main(int argc, char* argv[]) {
     int port = 8080;
     std::string room_name = "Basic Chat Room";
+    std::string capture_path;
     
     if (argc > 1) {
         port = std::stoi(argv[1]);
@@ -317,6 +346,10 @@ int main(int argc, char* argv[]) {
         room_name = argv[2];
     }
     
+    if (argc > 3) {
+        capture_path = argv[3];
+    }
+    
     log_info("Starting Basic Chat Room Server...");
     log_info("Room Name: " + room_name);
     log_info("Port: " + std::to_string(port));
@@ -325,6 +358,10 @@ int main(int argc, char* argv[]) {
     try {
         BasicChatRoom chat_room(room_name);
         
+        if (!capture_path.empty() && !chat_room.enable_capture(capture_path)) {
+            return 1;
+        }
+        
         if (!chat_room.start(port)) {
             log_err("Failed to start chat room server");
             return 1;
@@ -0,0 +1,557 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <ctime>
+#include "capture.hpp"
+
+#pragma comment(lib, "ws2_32.lib")
+
+typedef std::chrono::steady_clock Clock;
+
+static const long HANDSHAKE_TIMEOUT_S = 5;
+static const long DRAIN_TIMEOUT_S = 5;
+
+static std::string now_ts() {
+    std::time_t t = std::time(nullptr);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&t));
+    return std::string(buf);
+}
+
+static void log_info(const std::string& msg) {
+    std::cout << "[" << now_ts() << "] " << msg << std::endl;
+}
+
+static void log_err(const std::string& msg) {
+    std::cerr << "[" << now_ts() << "] ERROR: " << msg << std::endl;
+}
+
+static bool send_all(SOCKET s, const char* data, int len) {
+    int sent = 0;
+    while (sent < len) {
+        int n = send(s, data + sent, len - sent, 0);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+static bool recv_exact(SOCKET s, char* buf, int len) {
+    int got = 0;
+    while (got < len) {
+        int n = recv(s, buf + got, len - got, 0);
+        if (n <= 0) return false;
+        got += n;
+    }
+    return true;
+}
+
+static bool send_frame(SOCKET s, const std::string& payload) {
+    uint32_t nlen = htonl(static_cast<uint32_t>(payload.size()));
+    if (!send_all(s, reinterpret_cast<const char*>(&nlen), 4)) return false;
+    return send_all(s, payload.data(), static_cast<int>(payload.size()));
+}
+
+static bool recv_frame(SOCKET s, std::string& out) {
+    uint32_t nlen = 0;
+    if (!recv_exact(s, reinterpret_cast<char*>(&nlen), 4)) return false;
+    uint32_t len = ntohl(nlen);
+    if (len > 10 * 1024 * 1024) return false;
+    out.resize(len);
+    if (!recv_exact(s, &out[0], static_cast<int>(len))) return false;
+    return true;
+}
+
+static std::string json_get_string(const std::string& j, const std::string& key) {
+    std::string pat = "\"" + key + "\"";
+    size_t p = j.find(pat);
+    if (p == std::string::npos) return "";
+    p = j.find(':', p);
+    if (p == std::string::npos) return "";
+    p = j.find('"', p);
+    if (p == std::string::npos) return "";
+    size_t q = j.find('"', p + 1);
+    if (q == std::string::npos) return "";
+    std::string val = j.substr(p + 1, q - (p + 1));
+    std::string out;
+    out.reserve(val.size());
+    for (size_t i = 0; i < val.size(); ++i) {
+        if (val[i] == '\\' && i + 1 < val.size()) {
+            char n = val[i + 1];
+            if (n == 'n') { out.push_back('\n'); ++i; continue; }
+            out.push_back(n); ++i; continue;
+        }
+        out.push_back(val[i]);
+    }
+    return out;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+struct PendingDelivery {
+    Clock::time_point sent_at;
+    uint32_t origin; // conn that sent the frame
+};
+
+struct ReplayConn {
+    SOCKET sock;
+    std::string username;
+    // broadcasts this connection still expects, keyed by sender + content,
+    // holding the send time of each so delivery latency can be measured
+    std::map<std::string, std::deque<PendingDelivery>> expected;
+    size_t expected_count;
+    // broadcasts of this connection's frames not yet seen by their recipients
+    size_t owed_count;
+
+    ReplayConn() : sock(INVALID_SOCKET), expected_count(0), owed_count(0) {}
+};
+
+class TrafficReplayer {
+private:
+    std::string server_;
+    int port_;
+    double speed_; // 0 = as fast as possible
+    std::map<uint32_t, ReplayConn> conns_;
+
+    uint64_t frames_sent_;
+    uint64_t bytes_sent_;
+    uint64_t skipped_;
+    uint64_t undelivered_;
+    std::vector<double> latencies_us_;
+    Clock::time_point last_delivery_;
+    double elapsed_s_;
+
+    static std::string delivery_key(const std::string& sender, const std::string& content) {
+        return sender + '\x1f' + content;
+    }
+
+    SOCKET open_socket() {
+        SOCKET s = socket(AF_INET, SOCK_STREAM, 0);
+        if (s == INVALID_SOCKET) return INVALID_SOCKET;
+
+        // send_frame writes header and payload separately; without this, Nagle
+        // holds back the payload and the stall is counted as server latency
+        int nodelay = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
+
+        sockaddr_in server_addr;
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(port_);
+        server_addr.sin_addr.s_addr = inet_addr(server_.c_str());
+
+        if (::connect(s, (sockaddr*)&server_addr, sizeof(server_addr)) == SOCKET_ERROR) {
+            closesocket(s);
+            return INVALID_SOCKET;
+        }
+        return s;
+    }
+
+    // Waits up to HANDSHAKE_TIMEOUT_S for the USER_LIST reply to a username.
+    bool await_handshake(SOCKET s) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(s, &read_fds);
+        struct timeval timeout;
+        timeout.tv_sec = HANDSHAKE_TIMEOUT_S;
+        timeout.tv_usec = 0;
+        if (select(0, &read_fds, NULL, NULL, &timeout) <= 0) return false;
+        std::string frame;
+        return recv_frame(s, frame);
+    }
+
+    void settle(uint32_t origin) {
+        auto it = conns_.find(origin);
+        if (it != conns_.end() && it->second.owed_count > 0) it->second.owed_count--;
+    }
+
+    void close_conn(uint32_t conn_id) {
+        auto it = conns_.find(conn_id);
+        if (it == conns_.end()) return;
+        undelivered_ += it->second.expected_count;
+        for (const auto& entry : it->second.expected) {
+            for (const PendingDelivery& d : entry.second) settle(d.origin);
+        }
+        closesocket(it->second.sock);
+        conns_.erase(it);
+    }
+
+    // Before closing a conn, give the server up to DRAIN_TIMEOUT_S to deliver
+    // the broadcasts still owed to it and those of its own frames, so a client
+    // that talks and quits straight away is still measured.
+    void drain_conn(uint32_t conn_id) {
+        Clock::time_point deadline = Clock::now() + std::chrono::seconds(DRAIN_TIMEOUT_S);
+        Clock::time_point now;
+        while ((now = Clock::now()) < deadline) {
+            auto it = conns_.find(conn_id);
+            if (it == conns_.end()) return;
+            if (it->second.expected_count == 0 && it->second.owed_count == 0) break;
+            long long wait_us = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+            pump(std::min(wait_us, 100000LL));
+        }
+        close_conn(conn_id);
+    }
+
+    void apply(const CaptureRecord& rec) {
+        switch (rec.kind) {
+        case CaptureKind::CONNECT: {
+            close_conn(rec.conn_id);
+            SOCKET s = open_socket();
+            if (s == INVALID_SOCKET) {
+                log_err("Connect failed for conn " + std::to_string(rec.conn_id));
+                ++skipped_;
+                return;
+            }
+            std::string uname_line = rec.payload + "\n";
+            // The server reads the username with a single recv() and answers
+            // with USER_LIST; wait for it so the next frame is not coalesced
+            // into the username read.
+            if (!send_all(s, uname_line.c_str(), static_cast<int>(uname_line.size())) ||
+                !await_handshake(s)) {
+                log_err("Handshake failed for conn " + std::to_string(rec.conn_id));
+                closesocket(s);
+                ++skipped_;
+                return;
+            }
+            ReplayConn& conn = conns_[rec.conn_id];
+            conn.sock = s;
+            conn.username = rec.payload;
+            break;
+        }
+        case CaptureKind::FRAME: {
+            auto it = conns_.find(rec.conn_id);
+            if (it == conns_.end()) {
+                ++skipped_;
+                return;
+            }
+            Clock::time_point sent_at = Clock::now();
+            if (!send_frame(it->second.sock, rec.payload)) {
+                log_err("Send failed for conn " + std::to_string(rec.conn_id));
+                close_conn(rec.conn_id);
+                ++skipped_;
+                return;
+            }
+            ++frames_sent_;
+            bytes_sent_ += 4 + rec.payload.size();
+
+            // mirror the server: non-empty content is rebroadcast to everyone else
+            std::string content = json_get_string(rec.payload, "content");
+            if (!content.empty()) {
+                std::string key = delivery_key(it->second.username, content);
+                for (auto& entry : conns_) {
+                    if (entry.first == rec.conn_id) continue;
+                    PendingDelivery d;
+                    d.sent_at = sent_at;
+                    d.origin = rec.conn_id;
+                    entry.second.expected[key].push_back(d);
+                    entry.second.expected_count++;
+                    it->second.owed_count++;
+                }
+            }
+            break;
+        }
+        case CaptureKind::DISCONNECT:
+            drain_conn(rec.conn_id);
+            break;
+        }
+    }
+
+    void on_frame(ReplayConn& conn, const std::string& frame) {
+        if (json_get_string(frame, "type") != "CHAT") return;
+        std::string key = delivery_key(json_get_string(frame, "sender"),
+                                       json_get_string(frame, "content"));
+        auto it = conn.expected.find(key);
+        if (it == conn.expected.end() || it->second.empty()) return;
+
+        const PendingDelivery& d = it->second.front();
+        auto latency = Clock::now() - d.sent_at;
+        latencies_us_.push_back(static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(latency).count()));
+        settle(d.origin);
+        last_delivery_ = Clock::now();
+        it->second.pop_front();
+        if (it->second.empty()) conn.expected.erase(it);
+        conn.expected_count--;
+    }
+
+    // Reads everything the server has sent, waiting at most timeout_us for
+    // the first frame and then polling until no socket has data left, so
+    // queued broadcasts are not timestamped late on the next call.
+    void pump(long long timeout_us) {
+        if (timeout_us < 0) timeout_us = 0;
+        if (conns_.empty()) {
+            // select() rejects an empty set on Winsock
+            if (timeout_us > 0) Sleep(static_cast<DWORD>(timeout_us / 1000));
+            return;
+        }
+
+        while (!conns_.empty()) {
+            fd_set read_fds;
+            FD_ZERO(&read_fds);
+            for (auto& entry : conns_) {
+                FD_SET(entry.second.sock, &read_fds);
+            }
+
+            struct timeval timeout;
+            timeout.tv_sec = static_cast<long>(timeout_us / 1000000);
+            timeout.tv_usec = static_cast<long>(timeout_us % 1000000);
+
+            int activity = select(0, &read_fds, NULL, NULL, &timeout);
+            if (activity <= 0) return;
+            timeout_us = 0;
+
+            std::vector<uint32_t> lost;
+            for (auto& entry : conns_) {
+                if (!FD_ISSET(entry.second.sock, &read_fds)) continue;
+                std::string frame;
+                if (!recv_frame(entry.second.sock, frame)) {
+                    lost.push_back(entry.first);
+                    continue;
+                }
+                on_frame(entry.second, frame);
+            }
+            for (uint32_t id : lost) {
+                log_err("Server closed conn " + std::to_string(id));
+                close_conn(id);
+            }
+        }
+    }
+
+    size_t outstanding() const {
+        size_t n = 0;
+        for (const auto& entry : conns_) n += entry.second.expected_count;
+        return n;
+    }
+
+public:
+    TrafficReplayer(const std::string& server, int port, double speed)
+        : server_(server), port_(port), speed_(speed), frames_sent_(0), bytes_sent_(0),
+          skipped_(0), undelivered_(0), elapsed_s_(0.0) {}
+
+    ~TrafficReplayer() {
+        for (auto& entry : conns_) {
+            closesocket(entry.second.sock);
+        }
+        conns_.clear();
+        WSACleanup();
+    }
+
+    bool init() {
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            log_err("WSAStartup failed");
+            return false;
+        }
+        if (inet_addr(server_.c_str()) == INADDR_NONE) {
+            log_err("Invalid server address");
+            return false;
+        }
+        return true;
+    }
+
+    void run(const std::vector<CaptureRecord>& records) {
+        if (records.empty()) return;
+
+        // pace relative to the first record, not to when the capture was
+        // opened, so idle time before the first client is not replayed
+        uint64_t base_us = records.front().ts_us;
+        Clock::time_point start = Clock::now();
+
+        for (const CaptureRecord& rec : records) {
+            if (speed_ > 0) {
+                Clock::time_point due = start + std::chrono::microseconds(
+                    static_cast<long long>((rec.ts_us - base_us) / speed_));
+                Clock::time_point now;
+                while ((now = Clock::now()) < due) {
+                    long long wait_us = std::chrono::duration_cast<std::chrono::microseconds>(due - now).count();
+                    pump(std::min(wait_us, 100000LL));
+                }
+            }
+            pump(0);
+            apply(rec);
+        }
+
+        Clock::time_point sends_done = Clock::now();
+
+        // give in-flight broadcasts a chance to arrive before tearing down
+        Clock::time_point drain_deadline = Clock::now() + std::chrono::seconds(DRAIN_TIMEOUT_S);
+        while (outstanding() > 0 && Clock::now() < drain_deadline) {
+            pump(100000);
+        }
+
+        // the run ends when the server has delivered its last broadcast, not
+        // when the replayer finished writing into its socket buffers
+        Clock::time_point end = std::max(sends_done, last_delivery_);
+        elapsed_s_ = std::chrono::duration<double>(end - start).count();
+
+        std::vector<uint32_t> ids;
+        for (auto& entry : conns_) ids.push_back(entry.first);
+        for (uint32_t id : ids) close_conn(id);
+    }
+
+    std::map<std::string, double> results() {
+        std::sort(latencies_us_.begin(), latencies_us_.end());
+        double sum = 0.0;
+        for (double v : latencies_us_) sum += v;
+
+        std::map<std::string, double> r;
+        r["frames"] = static_cast<double>(frames_sent_);
+        r["bytes"] = static_cast<double>(bytes_sent_);
+        r["skipped"] = static_cast<double>(skipped_);
+        r["elapsed_s"] = elapsed_s_;
+        r["frames_per_s"] = elapsed_s_ > 0 ? frames_sent_ / elapsed_s_ : 0.0;
+        r["bytes_per_s"] = elapsed_s_ > 0 ? bytes_sent_ / elapsed_s_ : 0.0;
+        r["deliveries"] = static_cast<double>(latencies_us_.size());
+        r["deliveries_per_s"] = elapsed_s_ > 0 ? latencies_us_.size() / elapsed_s_ : 0.0;
+        r["undelivered"] = static_cast<double>(undelivered_);
+        r["lat_mean_us"] = latencies_us_.empty() ? 0.0 : sum / latencies_us_.size();
+        r["lat_p50_us"] = percentile(latencies_us_, 0.50);
+        r["lat_p99_us"] = percentile(latencies_us_, 0.99);
+        r["lat_max_us"] = latencies_us_.empty() ? 0.0 : latencies_us_.back();
+        return r;
+    }
+};
+
+static bool load_capture(const std::string& path, std::vector<CaptureRecord>& records) {
+    CaptureReader reader;
+    if (!reader.open(path)) {
+        log_err("Cannot read capture file: " + path);
+        return false;
+    }
+    CaptureRecord rec;
+    while (reader.next(rec)) {
+        records.push_back(rec);
+    }
+    if (reader.failed()) {
+        log_err("Capture file is truncated or corrupt after " + std::to_string(records.size()) +
+                " records; replay will be partial");
+    }
+    return true;
+}
+
+static bool load_report(const std::string& path, std::map<std::string, double>& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        try { out[line.substr(0, eq)] = std::stod(line.substr(eq + 1)); } catch (...) {}
+    }
+    return true;
+}
+
+static void print_usage() {
+    std::cout << "Usage: replayApp.exe <capture_file> [server] [port] "
+                 "[--speed N | --max] [--out report.txt] [--baseline report.txt]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> positional;
+    double speed = 1.0;
+    std::string out_path;
+    std::string baseline_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max") {
+            speed = 0.0;
+        } else if (arg == "--speed" && i + 1 < argc) {
+            try { speed = std::stod(argv[++i]); } catch (...) { speed = -1.0; }
+            if (speed <= 0) {
+                log_err("Speed must be a positive number");
+                return 1;
+            }
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (arg.compare(0, 2, "--") == 0) {
+            print_usage();
+            return 1;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    std::string capture_path = positional[0];
+    std::string server = positional.size() > 1 ? positional[1] : "127.0.0.1";
+    int port = 8080;
+    if (positional.size() > 2) {
+        try { port = std::stoi(positional[2]); } catch (...) { log_err("Invalid port"); return 1; }
+    }
+
+    std::vector<CaptureRecord> records;
+    if (!load_capture(capture_path, records)) {
+        return 1;
+    }
+
+    log_info("Loaded " + std::to_string(records.size()) + " records from " + capture_path);
+    log_info("Replaying against " + server + ":" + std::to_string(port) + " at " +
+             (speed > 0 ? std::to_string(speed) + "x" : std::string("max speed")));
+
+    std::map<std::string, double> results;
+    {
+        TrafficReplayer replayer(server, port, speed);
+        if (!replayer.init()) {
+            return 1;
+        }
+        replayer.run(records);
+        results = replayer.results();
+    }
+
+    std::cout.precision(10);
+    std::cout << "----------------------------------------" << std::endl;
+    for (const auto& kv : results) {
+        std::cout << kv.first << "=" << kv.second << std::endl;
+    }
+
+    if (!out_path.empty()) {
+        std::ofstream out(out_path);
+        if (!out) {
+            log_err("Cannot write report: " + out_path);
+        } else {
+            out.precision(10);
+            for (const auto& kv : results) {
+                out << kv.first << "=" << kv.second << "\n";
+            }
+            log_info("Report written to " + out_path);
+        }
+    }
+
+    if (!baseline_path.empty()) {
+        std::map<std::string, double> baseline;
+        if (!load_report(baseline_path, baseline)) {
+            log_err("Cannot read baseline report: " + baseline_path);
+            return 1;
+        }
+        std::cout << "---------- delta vs baseline -----------" << std::endl;
+        for (const auto& kv : results) {
+            auto it = baseline.find(kv.first);
+            if (it == baseline.end()) continue;
+            std::cout << kv.first << ": " << it->second << " -> " << kv.second;
+            if (it->second != 0) {
+                double pct = (kv.second - it->second) / it->second * 100.0;
+                std::cout << " (" << (pct >= 0 ? "+" : "") << pct << "%)";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    return 0;
+}